@@ -1,12 +1,18 @@
 // Include Files:
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 #include <esp_rmaker_core.h>
 #include <esp_rmaker_standard_params.h>
 #include <esp_rmaker_standard_devices.h>
+#include <esp_rmaker_utils.h>
 #include <app_network.h>
 #include "app_priv.h"
 #include "lcd_i2c.h"
+#include "rise_detect.h"
+#include "fixfmt.h"
+#include "fast_connect.h"
+#include "local_mqtt.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
@@ -34,20 +40,17 @@ static esp_rmaker_param_t *most_polluted_ppm;
 #define BUFFER_SIZE            5
 #define READ_INTERVAL_MS       200
 #define REPORT_INTERVAL_MS     1000
+#define LCD_CO_CELL_WIDTH      12      // Cột 4..15 sau "CO: "
+#define LCD_PM25_CELL_WIDTH    9       // Cột 7..15 sau "PM2.5: "
 static volatile bool alert_mode_enabled = false;
 static QueueHandle_t btn_evt_queue = NULL;
 static uint32_t last_alert_time = 0;
 #define ALERT_INTERVAL_MS      5000 
 
-// CO Buffer
-static float ppm_buf[BUFFER_SIZE] = {0};
-static int ppm_index = 0;
-static int ppm_count = 0;
-
-// PM2.5 buffer:
-static float pm25_buf[BUFFER_SIZE] = {0};
-static int pm25_index = 0;
-static int pm25_count = 0;
+// Sample buffer (mỗi phần tử là 1 bản ghi CO + PM2.5):
+static sensor_sample_t sample_buf[BUFFER_SIZE] = {0};
+static int sample_index = 0;
+static int sample_count = 0;
 
 // Cache for RainMaker updates (avoid redundant calls):
 static struct {
@@ -64,9 +67,34 @@ static struct {
 // Alert state tracking:
 static int last_danger = -1;
 
-// Buzzer control flags (non-blocking):
+// Rapid-rise detection (CUSUM + slope) cho CO và PM2.5:
+static const rise_params_t co_rise_params = {
+    .alpha = RISE_CO_ALPHA,
+    .slope_alpha = RISE_CO_SLOPE_ALPHA,
+    .drift = RISE_CO_DRIFT,
+    .threshold = RISE_CO_THRESHOLD,
+    .min_slope = RISE_CO_MIN_SLOPE,
+    .warmup = RISE_WARMUP_SAMPLES
+};
+static const rise_params_t pm25_rise_params = {
+    .alpha = RISE_PM25_ALPHA,
+    .slope_alpha = RISE_PM25_SLOPE_ALPHA,
+    .drift = RISE_PM25_DRIFT,
+    .threshold = RISE_PM25_THRESHOLD,
+    .min_slope = RISE_PM25_MIN_SLOPE,
+    .warmup = RISE_WARMUP_SAMPLES
+};
+static rise_detector_t co_rise;
+static rise_detector_t pm25_rise;
+static bool last_rise = false;
+static uint32_t last_rise_alert_time = 0;
+static bool rise_blink = false;
+
+// Buzzer control (non-blocking, tắt bằng one-shot esp_timer):
+#define BUZZ_DANGER_US         50000   // Nguy hiểm: bíp 50ms mỗi giây (như cũ)
+#define BUZZ_RISE_US           30000   // Tăng nhanh: chirp 30ms mỗi giây
 static volatile bool buzzer_active = false;
-static uint32_t buzzer_end_time = 0;
+static esp_timer_handle_t buzzer_timer = NULL;
 
 // Rainmaker bulk write callback:
 static esp_err_t bulk_write_cb(const esp_rmaker_device_t *device,
@@ -112,59 +140,62 @@ static void button_task(void *arg) {
 
 // MQ2 and PM2.5 measuring timer (200ms in average):
 static void measuring_timer_cb(void *arg) {
-    // Read CO PPM
-    float ppm = read_CO_ppm();
-    ppm_buf[ppm_index] = ppm;
-    ppm_index = (ppm_index + 1) % BUFFER_SIZE;
-    if (ppm_count < BUFFER_SIZE)
-        ppm_count++;
-    
-    // Read PM2.5:
-    float pm25 = read_PM25_ppm();
-    pm25_buf[pm25_index] = pm25;
-    pm25_index = (pm25_index + 1) % BUFFER_SIZE;
-    if (pm25_count < BUFFER_SIZE)
-        pm25_count++;
+    // Một lần đo -> một bản ghi (raw, mV, Rs/R0, ppm):
+    sensor_sample_t *s = &sample_buf[sample_index];
+    read_sensors(s);
+    sample_index = (sample_index + 1) % BUFFER_SIZE;
+    if (sample_count < BUFFER_SIZE)
+        sample_count++;
+    rise_detector_update(&co_rise, s->co_ppm, READ_INTERVAL_MS / 1000.0f);
+    rise_detector_update(&pm25_rise, s->pm25, READ_INTERVAL_MS / 1000.0f);
 }
 
-// Non-blocking buzzer handler:
-static inline void buzzer_update(void) {
-    if (buzzer_active && esp_timer_get_time() >= buzzer_end_time) {
-        gpio_set_level(BUZZ_PIN, 0);
-        buzzer_active = false;
-    }
+// Buzzer off (one-shot timer callback):
+static void buzzer_off_cb(void *arg) {
+    gpio_set_level(BUZZ_PIN, 0);
+    buzzer_active = false;
 }
 
-// Buzzer trigger (non-blocking):
+// Buzzer stop (khi tắt chế độ cảnh báo):
+static inline void buzzer_stop(void) {
+    esp_timer_stop(buzzer_timer);
+    buzzer_off_cb(NULL);
+}
+
+// Buzzer trigger (non-blocking, tự tắt sau duration_us):
 static inline void buzzer_trigger(uint32_t duration_us) {
     if (!buzzer_active) {
         gpio_set_level(BUZZ_PIN, 1);
         buzzer_active = true;
-        buzzer_end_time = esp_timer_get_time() + duration_us;
-    } else {
-        gpio_set_level(BUZZ_PIN, 0);
+        esp_timer_start_once(buzzer_timer, duration_us);
     }
 }
 
 // LCD + RainMaker reporting timer (1s in average):
 static void report_timer_cb(void *arg) {
-    if (ppm_count == 0) return;
+    if (sample_count == 0) return;
     
-    // Average CO PPM:
-    float sum_ppm = 0;
-    for (int i = 0; i < ppm_count; i++) sum_ppm += ppm_buf[i];
-    float avg_ppm = sum_ppm / ppm_count;
+    // Average CO PPM, PM2.5 và Rs/R0 (cùng các bản ghi, không đọc lại ADC):
+    float sum_ppm = 0, sum_pm25 = 0, sum_ratio = 0;
+    for (int i = 0; i < sample_count; i++) {
+        sum_ppm += sample_buf[i].co_ppm;
+        sum_pm25 += sample_buf[i].pm25;
+        sum_ratio += sample_buf[i].ratio;
+    }
+    float avg_ppm = sum_ppm / sample_count;
+    float avg_pm25 = sum_pm25 / sample_count;
+    float ratio = sum_ratio / sample_count;
     
-    // Average PM2.5
-    float sum_pm25 = 0;
-    for (int i = 0; i < pm25_count; i++) sum_pm25 += pm25_buf[i];
-    float avg_pm25 = (pm25_count > 0) ? (sum_pm25 / pm25_count) : 0;
+    // Fixed-point (CO: 2 chữ số thập phân, PM2.5: 3 chữ số):
+    int32_t ppm_fx = fixfmt_scale(avg_ppm, 2);
+    int32_t pm25_fx = fixfmt_scale(avg_pm25, 3);
+    int32_t pm25_lcd_fx = fixfmt_scale(avg_pm25, 0);     // LCD: số nguyên để vừa " ug/m3"
     
-    // LCD update:
-    char buf[32];
-    char bufpm25[32];
-    snprintf(buf, sizeof(buf), "%.2f    ", avg_ppm);
-    snprintf(bufpm25, sizeof(bufpm25), "%.3f    ", avg_pm25);
+    // LCD update (ô căn phải, ghi đè toàn bộ giá trị cũ):
+    char buf[LCD_CO_CELL_WIDTH + 1];
+    char bufpm25[LCD_PM25_CELL_WIDTH + 1];
+    fixfmt_cell(buf, LCD_CO_CELL_WIDTH, ppm_fx, 2, " ppm");
+    fixfmt_cell(bufpm25, LCD_PM25_CELL_WIDTH, pm25_lcd_fx, 0, " ug/m3");
     lcd_put_cursor(0, 0);
     lcd_send_string("CO: ");
     lcd_put_cursor(0, 4);
@@ -174,29 +205,46 @@ static void report_timer_cb(void *arg) {
     lcd_put_cursor(1, 7);
     lcd_send_string(bufpm25);
     
-    // Tính toán Rs/R0:
-    uint16_t adc = adc1_get_raw(MQ2_CHANNEL);
-    float Vout = (adc / 4095.0f) * 3.3f;
-    float RS = RL_VALUE * (3.3f - Vout) / Vout;
-    float ratio = RS / get_R0();
+#if CONFIG_FIXFMT_BENCHMARK
+    // Stack còn trống thấp nhất của task esp_timer (để chỉnh ESP_TIMER_TASK_STACK_SIZE):
+    static int report_count = 0;
+    if (++report_count % 60 == 0) {
+        ESP_LOGI(TAG, "esp_timer stack high water mark: %u bytes free",
+                 (unsigned)uxTaskGetStackHighWaterMark(NULL));
+    }
+#endif
+#if CONFIG_ADC_STATS
+    const char *adc_path = "new";
+#if CONFIG_ADC_STATS_LEGACY_READ
+    // Đường cũ: reporter đọc thêm ADC (kết quả chỉ để so sánh, không được dùng):
+    float legacy_ratio = read_ratio_legacy();
+    adc_path = "old";
+    ESP_LOGI(TAG, "Rs/R0: reporter read %.3f, averaged records %.3f", legacy_ratio, ratio);
+#endif
+    // Mức sử dụng ADC1 trong chu kỳ báo cáo:
+    uint32_t conversions, busy_us;
+    get_adc_stats(&conversions, &busy_us);
+    ESP_LOGI(TAG, "ADC1 (%s path): %lu conversions, %lu us busy in %d ms",
+             adc_path, (unsigned long)conversions, (unsigned long)busy_us, REPORT_INTERVAL_MS);
+#endif
     
     // Message status CO:
     char status_msg[64];
     int co_level = 0;
     if (avg_ppm < 4.5) {
-        snprintf(status_msg, sizeof(status_msg), "CO tốt.");
+        fixfmt_append_str(status_msg, sizeof(status_msg), 0, "CO tốt.");
         co_level = 0;
     } else if (avg_ppm < 9.5) {
-        snprintf(status_msg, sizeof(status_msg), "CO trung bình.");
+        fixfmt_append_str(status_msg, sizeof(status_msg), 0, "CO trung bình.");
         co_level = 1;
     } else if (avg_ppm < 12.5) {
-        snprintf(status_msg, sizeof(status_msg), "CO không tốt.");
+        fixfmt_append_str(status_msg, sizeof(status_msg), 0, "CO không tốt.");
         co_level = 2;
     } else if (avg_ppm < 15.5) {
-        snprintf(status_msg, sizeof(status_msg), "CO xấu. Cẩn thận!");
+        fixfmt_append_str(status_msg, sizeof(status_msg), 0, "CO xấu. Cẩn thận!");
         co_level = 3;
     } else {
-        snprintf(status_msg, sizeof(status_msg), "CO rất xấu! NGUY HIỂM!");
+        fixfmt_append_str(status_msg, sizeof(status_msg), 0, "CO rất xấu! NGUY HIỂM!");
         co_level = 4;
     }
     
@@ -204,31 +252,52 @@ static void report_timer_cb(void *arg) {
     char status2_msg[64];
     int pm_level = 0;
     if (avg_pm25 < 9) {
-        snprintf(status2_msg, sizeof(status2_msg), "PM2.5 tốt.");
+        fixfmt_append_str(status2_msg, sizeof(status2_msg), 0, "PM2.5 tốt.");
         pm_level = 0;
     } else if (avg_pm25 < 35.4) {
-        snprintf(status2_msg, sizeof(status2_msg), "PM2.5 an toàn.");
+        fixfmt_append_str(status2_msg, sizeof(status2_msg), 0, "PM2.5 an toàn.");
         pm_level = 1;
     } else if (avg_pm25 < 55.4) {
-        snprintf(status2_msg, sizeof(status2_msg), "PM2.5 trung bình.");
+        fixfmt_append_str(status2_msg, sizeof(status2_msg), 0, "PM2.5 trung bình.");
         pm_level = 2;
     } else if (avg_pm25 < 125.5) {
-        snprintf(status2_msg, sizeof(status2_msg), "PM2.5 kém.");
+        fixfmt_append_str(status2_msg, sizeof(status2_msg), 0, "PM2.5 kém.");
         pm_level = 3;
     } else {
-        snprintf(status2_msg, sizeof(status2_msg), "PM2.5 rất xấu!");
+        fixfmt_append_str(status2_msg, sizeof(status2_msg), 0, "PM2.5 rất xấu!");
         pm_level = 4;
     }
     
     // LED warning + Buzzer (non-blocking):
     int danger = (co_level > pm_level) ? co_level : pm_level;
+    bool rising = co_rise.alarm || pm25_rise.alarm;
     if (alert_mode_enabled) {
         int duty_table[5] = {0, 255/32, 255/16, 255/8, 255};
-        ledc_set_duty(LEDC_MODE, LEDC_CHANNEL, duty_table[danger]);
+        // Tăng nhanh nhưng chưa vượt ngưỡng: LED nhấp nháy (khác với mức sáng cố định):
+        if (rising && danger < 3) {
+            rise_blink = !rise_blink;
+            ledc_set_duty(LEDC_MODE, LEDC_CHANNEL, rise_blink ? 255 : 0);
+        } else {
+            ledc_set_duty(LEDC_MODE, LEDC_CHANNEL, duty_table[danger]);
+        }
         ledc_update_duty(LEDC_MODE, LEDC_CHANNEL);
+        // Cảnh báo sớm khi nồng độ tăng nhanh (chưa tới mức nguy hiểm):
+        if (rising && danger < 3) {
+            buzzer_trigger(BUZZ_RISE_US);
+            uint32_t now = esp_timer_get_time() / 1000;
+            if (!last_rise || (now - last_rise_alert_time >= ALERT_INTERVAL_MS)) {
+                esp_rmaker_raise_alert(
+                    co_rise.alarm ?
+                    "Nồng độ CO đang tăng nhanh! Có thể có cháy âm ỉ!" :
+                    "Nồng độ PM2.5 đang tăng nhanh! Có thể có khói!"
+                );
+                last_rise_alert_time = now;
+            }
+        }
+        last_rise = rising;
         // Trigger buzzer if danger >= 3 (non-blocking):
         if (danger >= 3) {
-            buzzer_trigger(50000);  // 50ms buzz, no blocking
+            buzzer_trigger(BUZZ_DANGER_US);  // no blocking
             // Pop up alert only when danger level changes to >= 3:
             uint32_t now = esp_timer_get_time() / 1000;  // Convert to ms
             if ((last_danger < 3) || (now - last_alert_time >= 5000)) {
@@ -244,20 +313,20 @@ static void report_timer_cb(void *arg) {
     } else {
         ledc_set_duty(LEDC_MODE, LEDC_CHANNEL, 0);
         ledc_update_duty(LEDC_MODE, LEDC_CHANNEL);
-        gpio_set_level(BUZZ_PIN, 0);
-        buzzer_active = false;
+        buzzer_stop();
         last_danger = -1;
+        last_rise = false;
     }
     
-    // Update buzzer state:
-    buzzer_update();
-    
     // Kiểm tra cái nào ô nhiễm:
     char polluted_msg[64];
+    size_t len;
     if (co_level > pm_level) {
-        snprintf(polluted_msg, sizeof(polluted_msg), "Khí CO: %.2f ppm", avg_ppm);
+        len = fixfmt_append_str(polluted_msg, sizeof(polluted_msg), 0, "Khí CO: ");
+        fixfmt_append(polluted_msg, sizeof(polluted_msg), len, ppm_fx, 2, " ppm");
     } else {
-        snprintf(polluted_msg, sizeof(polluted_msg), "Bụi PM2.5: %.3f mg/m3", avg_pm25);
+        len = fixfmt_append_str(polluted_msg, sizeof(polluted_msg), 0, "Bụi PM2.5: ");
+        fixfmt_append(polluted_msg, sizeof(polluted_msg), len, pm25_fx, 3, " ug/m3");
     }
     
     // Update RainMaker only if values changed significantly:
@@ -288,6 +357,19 @@ static void report_timer_cb(void *arg) {
         strcpy(last_reported.polluted, polluted_msg);
     }
     
+    // Local MQTT sink (không block, độc lập với RainMaker):
+    local_mqtt_frame_t frame = {
+        .uptime_ms = esp_timer_get_time() / 1000,
+        .ts = esp_rmaker_time_check() ? (int32_t)time(NULL) : 0,
+        .co_ppm = ppm_fx,
+        .pm25 = pm25_fx,
+        .ratio = fixfmt_scale(ratio, 3),
+        .co_level = co_level,
+        .pm_level = pm_level,
+        .rising = rising
+    };
+    local_mqtt_submit(&frame);
+    
     // Always update power param (nó thay đổi từ button):
     esp_rmaker_param_update_and_report(param_power, esp_rmaker_bool(alert_mode_enabled));
 }
@@ -305,6 +387,7 @@ void app_main(void) {
     }
     // ---- WiFi + RainMaker Base ----
     app_network_init();
+    fast_connect_init();
     esp_rmaker_config_t cfg = { .enable_time_sync = true };
     esp_rmaker_node_t *node = esp_rmaker_node_init(
         &cfg, "CO and PM2.5 monitor", "Sensor");
@@ -346,8 +429,15 @@ void app_main(void) {
         ESP_LOGE(TAG, "Failed WiFi provisioning");
         return;
     }
+    // ---- Local MQTT ----
+    local_mqtt_init();
     // ---- Drivers ----
     app_driver_init();
+#if CONFIG_FIXFMT_BENCHMARK
+    fixfmt_benchmark();
+#endif
+    rise_detector_init(&co_rise, &co_rise_params);
+    rise_detector_init(&pm25_rise, &pm25_rise_params);
     // ---- Button ----
     btn_evt_queue = xQueueCreate(10, sizeof(uint32_t));
     gpio_reset_pin(ALERT_BUTTON_PIN);
@@ -358,6 +448,11 @@ void app_main(void) {
     gpio_isr_handler_add(ALERT_BUTTON_PIN, button_isr, (void*)ALERT_BUTTON_PIN);
     xTaskCreate(button_task, "button_task", 4096, NULL, 10, NULL);
     // ---- Timers ----
+    const esp_timer_create_args_t buzz_args = {
+        .callback = buzzer_off_cb,
+        .name = "buzzer_off"
+    };
+    esp_timer_create(&buzz_args, &buzzer_timer);
     const esp_timer_create_args_t mq2_args = {
         .callback = measuring_timer_cb,
         .name = "mq2_timer"
@@ -1,77 +1,163 @@
 // ==== Includes ====
 #include "app_priv.h"
 #include "esp_log.h"
-#include "driver/adc.h"
+#include "esp_adc/adc_oneshot.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_rom_sys.h"
 #include "lcd_i2c.h"
 #include <math.h>
+#if CONFIG_ADC_STATS
+#include "esp_timer.h"
+#endif
 
 static const char *TAG = "MQ2_DRIVER";
 static float R0 = 0;
+static adc_oneshot_unit_handle_t adc1_handle = NULL;
+static adc_cali_handle_t adc1_cali = NULL;     // NULL nếu chip không hỗ trợ hiệu chuẩn
+
+#if CONFIG_ADC_STATS
+static uint32_t adc_conversions = 0;
+static uint32_t adc_busy_us = 0;
+static void adc_stats_reset(void) {
+    adc_conversions = 0;
+    adc_busy_us = 0;
+}
+#endif
+
+// ======== ADC Read ========
+static int adc_read(adc_channel_t channel) {
+    int raw = 0;
+#if CONFIG_ADC_STATS
+    int64_t t0 = esp_timer_get_time();
+#endif
+    adc_oneshot_read(adc1_handle, channel, &raw);
+#if CONFIG_ADC_STATS
+    adc_busy_us += (uint32_t)(esp_timer_get_time() - t0);
+    adc_conversions++;
+#endif
+    return raw;
+}
+
+// Raw -> mV (dùng hiệu chuẩn eFuse nếu có, nếu không thì tuyến tính):
+static int adc_raw_to_mv(int raw) {
+    int mv;
+    if (adc1_cali && adc_cali_raw_to_voltage(adc1_cali, raw, &mv) == ESP_OK)
+        return mv;
+    return raw * ADC_VREF_MV / 4095;
+}
+
+// Rs của MQ2 từ điện áp ra (mV):
+static float MQ2_RS_calc(int mv) {
+    if (mv <= 0) mv = 1;
+    return RL_VALUE * (float)(ADC_VREF_MV - mv) / mv;
+}
 
 // ======== Calibration ========
 static void calibrate_R0(void) {
     uint32_t sum = 0;
     for (int i = 0; i < 50; i++) {
-        sum += adc1_get_raw(MQ2_CHANNEL);
+        sum += adc_read(MQ2_CHANNEL);
         vTaskDelay(pdMS_TO_TICKS(10));   // giữ nguyên
     }
     uint16_t avg_adc = sum / 50;
-    float V_out = (avg_adc / 4095.0f) * 3.3f;
-    float RS = RL_VALUE * (3.3f - V_out) / V_out;
+    float RS = MQ2_RS_calc(adc_raw_to_mv(avg_adc));
     R0 = RS / RATIO_CLEAN_AIR;
     ESP_LOGI(TAG, "R0 calibrated: %.2f ohm", R0);
+#if CONFIG_ADC_STATS
+    adc_stats_reset();     // Chu kỳ thống kê đầu tiên không tính 50 lần đọc hiệu chuẩn
+#endif
 }
 
 // ======== ADC Init ========
 static void ADC_init(void) {
-    adc1_config_width(ADC_WIDTH_BIT_12);
-    adc1_config_channel_atten(MQ2_CHANNEL, ADC_ATTEN_DB_11);
+    adc_oneshot_unit_init_cfg_t unit_cfg = {
+        .unit_id = ADC_UNIT_1,
+    };
+    ESP_ERROR_CHECK(adc_oneshot_new_unit(&unit_cfg, &adc1_handle));
+    adc_oneshot_chan_cfg_t chan_cfg = {
+        .bitwidth = ADC_BITWIDTH_12,
+        .atten = ADC_ATTEN,
+    };
+    ESP_ERROR_CHECK(adc_oneshot_config_channel(adc1_handle, MQ2_CHANNEL, &chan_cfg));
+    ESP_ERROR_CHECK(adc_oneshot_config_channel(adc1_handle, PM25_ADC_CHANNEL, &chan_cfg));
+    // Hiệu chuẩn (cả 2 kênh cùng unit + atten nên dùng chung 1 scheme):
+    esp_err_t err = ESP_ERR_NOT_SUPPORTED;
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_curve_fitting_config_t cali_cfg = {
+        .unit_id = ADC_UNIT_1,
+        .atten = ADC_ATTEN,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    err = adc_cali_create_scheme_curve_fitting(&cali_cfg, &adc1_cali);
+#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_line_fitting_config_t cali_cfg = {
+        .unit_id = ADC_UNIT_1,
+        .atten = ADC_ATTEN,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    err = adc_cali_create_scheme_line_fitting(&cali_cfg, &adc1_cali);
+#endif
+    if (err != ESP_OK) {
+        adc1_cali = NULL;
+        ESP_LOGW(TAG, "ADC calibration not available, using linear conversion");
+    }
 }
 
 // ======== PPM Calculation ========
-static float CO_ppm_calc(uint16_t adc_raw) {
+static float CO_ppm_calc(float ratio) {
     float A = 87.9054905f;
     float B = -1.289602592f;
-    float V_out = (adc_raw / 4095.0f) * 3.3f;
-    float RS = RL_VALUE * (3.3f - V_out) / V_out;
-    float ratio = RS / R0;
     float ppm = A * powf(ratio, B);
     float offset = 17.0f;
     return (ppm > offset) ? (ppm - offset) : 0;
 }
 
-// ======== Read CO PPM ========
-float read_CO_ppm(void) {
+// ======== Read Sensors (1 lần đo = 1 bản ghi) ========
+void read_sensors(sensor_sample_t *out) {
+    // MQ2 (CO):
     uint32_t sum = 0;
     for (int i = 0; i < 10; i++) {
-        sum += adc1_get_raw(MQ2_CHANNEL);
+        sum += adc_read(MQ2_CHANNEL);
         esp_rom_delay_us(5000);    // 5 ms → không block scheduler
     }
-    uint16_t adc_raw = sum / 10;
-    return CO_ppm_calc(adc_raw);
-}
+    out->co_raw = sum / 10;
+    out->co_mv = adc_raw_to_mv(out->co_raw);
+    out->ratio = MQ2_RS_calc(out->co_mv) / R0;
+    out->co_ppm = CO_ppm_calc(out->ratio);
 
-// ======== PM2.5 Read ========
-float read_PM25_ppm(void) {
-    // Bật LED GP2Y trước khi đọc
+    // GP2Y (PM2.5): bật LED GP2Y trước khi đọc
     gpio_set_level(GP2Y_LED_POWER, 1);
     vTaskDelay(pdMS_TO_TICKS(0.28)); // ~280us datasheet
-    uint32_t sum = 0;
+    sum = 0;
     for (int i = 0; i < 10; i++) {
-        sum += adc1_get_raw(PM25_ADC_CHANNEL);
+        sum += adc_read(PM25_ADC_CHANNEL);
         vTaskDelay(pdMS_TO_TICKS(2));
     }
-    uint16_t adc_raw = sum / 10;
     gpio_set_level(GP2Y_LED_POWER, 0); // Tắt LED
-    float V_out = (adc_raw / 4095.0f) * 3.3f;
-    float dust_density = 0.17 * V_out * 1000; // ug/m³ (có thể hiệu chỉnh hệ số 0.17)
-    if (dust_density < 0) dust_density = 0;
-    return dust_density;
+    out->pm25_raw = sum / 10;
+    out->pm25_mv = adc_raw_to_mv(out->pm25_raw);
+    float dust_density = 0.17f * out->pm25_mv; // ug/m³ (có thể hiệu chỉnh hệ số 0.17)
+    out->pm25 = (dust_density < 0) ? 0 : dust_density;
+}
+
+#if CONFIG_ADC_STATS
+void get_adc_stats(uint32_t *conversions, uint32_t *busy_us) {
+    *conversions = adc_conversions;
+    *busy_us = adc_busy_us;
+    adc_stats_reset();
+}
+#endif
+
+#if CONFIG_ADC_STATS_LEGACY_READ
+// Mô phỏng đường cũ: reporter đọc thêm 1 lần MQ2 không lọc để tính Rs/R0.
+float read_ratio_legacy(void) {
+    return MQ2_RS_calc(adc_raw_to_mv(adc_read(MQ2_CHANNEL))) / R0;
 }
+#endif
 
 // ======== Getter ========
 float get_R0(void) {
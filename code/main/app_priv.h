@@ -3,11 +3,14 @@
 #include <stdbool.h>
 #include <driver/ledc.h>
 #include "driver/gpio.h"
-#include "driver/adc.h"
+#include "esp_adc/adc_oneshot.h"
+#include "sdkconfig.h"
 
 // ================= MQ2 + GP2Y + ADC =================
-#define MQ2_CHANNEL       ADC1_CHANNEL_0        // GPIO0
-#define PM25_ADC_CHANNEL  ADC1_CHANNEL_1        // GPIO1
+#define MQ2_CHANNEL       ADC_CHANNEL_0         // GPIO0 (ADC1)
+#define PM25_ADC_CHANNEL  ADC_CHANNEL_1         // GPIO1 (ADC1)
+#define ADC_ATTEN         ADC_ATTEN_DB_12
+#define ADC_VREF_MV       3300                  // Điện áp cấp cho MQ2 / dải đo ADC
 #define RL_VALUE          5000
 #define RATIO_CLEAN_AIR   3.0                   // Tỷ lệ Rs/R0 trong không khí sạch (được cung cấp bởi datasheet)
 
@@ -25,10 +28,30 @@
 #define LEDC_DUTY_RES     LEDC_TIMER_8_BIT
 #define LEDC_FREQUENCY    5000  // 5 kHz
 
+// ==================== Sample record ====================
+// Một lần đo tạo ra một bản ghi; LCD, RainMaker, cảnh báo chỉ đọc từ bản ghi này
+// và không bao giờ tự đọc ADC.
+typedef struct {
+    uint16_t co_raw;        // ADC counts (trung bình 10 lần đọc)
+    uint16_t pm25_raw;
+    int co_mv;              // mV sau hiệu chuẩn esp_adc
+    int pm25_mv;
+    float ratio;            // Rs/R0 của MQ2
+    float co_ppm;
+    float pm25;             // Mật độ bụi
+} sensor_sample_t;
+
 // ==================== Functions ====================
 void app_driver_init(void);
-float read_CO_ppm(void);
-float read_PM25_ppm(void);
+void read_sensors(sensor_sample_t *out);
+#if CONFIG_ADC_STATS
+// Số lần chuyển đổi ADC và thời gian chiếm ADC (us) kể từ lần gọi trước.
+void get_adc_stats(uint32_t *conversions, uint32_t *busy_us);
+#endif
+#if CONFIG_ADC_STATS_LEGACY_READ
+// Rs/R0 từ 1 lần đọc ADC trực tiếp như reporter cũ (chỉ dùng để so sánh).
+float read_ratio_legacy(void);
+#endif
 
 // ==================== Getter ====================
 float get_R0(void); // getter R0
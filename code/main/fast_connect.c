@@ -0,0 +1,228 @@
+// ==== Includes ====
+#include "fast_connect.h"
+#include <string.h>
+#include <esp_rmaker_common_events.h>
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+static const char *TAG = "FAST_CONN";
+
+static fast_connect_cache_t cache;
+static bool cache_valid = false;
+static bool directed = false;      // Đang thử kết nối trực tiếp bằng cache
+static bool mqtt_logged = false;
+static int directed_failures = 0;   // Số lần mất kết nối liên tiếp khi đang kết nối trực tiếp
+static wifi_scan_method_t orig_scan_method = WIFI_FAST_SCAN;   // scan_method trước khi ghim
+#if CONFIG_FAST_CONNECT_STATIC_IP
+static bool static_ip_pending = false;  // Áp dụng IP tĩnh ở lần kết nối tới
+static bool static_ip_active = false;
+static esp_timer_handle_t static_ip_timer = NULL;
+#endif
+
+// ======== NVS ========
+static bool cache_load(void) {
+    nvs_handle_t h;
+    if (nvs_open(FAST_CONNECT_NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return false;
+    size_t len = sizeof(cache);
+    esp_err_t err = nvs_get_blob(h, FAST_CONNECT_NVS_KEY, &cache, &len);
+    nvs_close(h);
+    return (err == ESP_OK) && (len == sizeof(cache));
+}
+
+static void cache_save(void) {
+    nvs_handle_t h;
+    if (nvs_open(FAST_CONNECT_NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+    if (nvs_set_blob(h, FAST_CONNECT_NVS_KEY, &cache, sizeof(cache)) == ESP_OK)
+        nvs_commit(h);
+    nvs_close(h);
+}
+
+static void cache_erase(void) {
+    nvs_handle_t h;
+    if (nvs_open(FAST_CONNECT_NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+    nvs_erase_key(h, FAST_CONNECT_NVS_KEY);
+    nvs_commit(h);
+    nvs_close(h);
+}
+
+// ======== Wi-Fi storage ========
+// Cấu hình "ghim" BSSID/kênh chỉ giữ trong RAM; khôi phục lưu flash khi đã
+// kết nối được hoặc đã quay về quét đầy đủ, để flash không bao giờ bị ghim.
+static void storage_restore_flash(void) {
+    esp_wifi_set_storage(WIFI_STORAGE_FLASH);
+}
+
+// ======== Static IP (tuỳ chọn) ========
+#if CONFIG_FAST_CONNECT_STATIC_IP
+static void static_ip_revert(void) {
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (netif) esp_netif_dhcpc_start(netif);
+    static_ip_active = false;
+    static_ip_pending = false;
+}
+
+// Gọi khi STA đã associate (giống ví dụ static_ip của ESP-IDF):
+static void static_ip_apply(void) {
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (!netif) return;
+    esp_netif_ip_info_t ip_info = {
+        .ip = cache.ip,
+        .netmask = cache.netmask,
+        .gw = cache.gw
+    };
+    esp_err_t err = esp_netif_dhcpc_stop(netif);
+    if ((err != ESP_OK && err != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED) ||
+        esp_netif_set_ip_info(netif, &ip_info) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to set static IP, using DHCP");
+        static_ip_revert();
+        return;
+    }
+    esp_netif_dns_info_t dns = { .ip.u_addr.ip4 = cache.dns, .ip.type = ESP_IPADDR_TYPE_V4 };
+    esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+    static_ip_active = true;
+    // Nếu không lên được MQTT trong thời gian chờ, coi như IP cũ không còn hợp lệ:
+    esp_timer_stop(static_ip_timer);
+    esp_timer_start_once(static_ip_timer, CONFIG_FAST_CONNECT_STATIC_IP_TIMEOUT_S * 1000000ULL);
+    ESP_LOGI(TAG, "Using cached IP " IPSTR " as static", IP2STR(&cache.ip));
+}
+
+static void static_ip_timeout_cb(void *arg) {
+    if (!static_ip_active) return;
+    ESP_LOGW(TAG, "No MQTT connection on static IP " IPSTR ", falling back to DHCP",
+             IP2STR(&cache.ip));
+    static_ip_revert();
+}
+#endif
+
+// ======== Fallback: quét đầy đủ ========
+static void fallback_full_scan(void) {
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) return;
+    cfg.sta.bssid_set = false;
+    cfg.sta.channel = 0;
+    cfg.sta.scan_method = orig_scan_method;
+    // app_network đã gọi esp_wifi_connect() trước handler này; ngắt trước khi đổi cấu hình.
+    esp_err_t err = esp_wifi_disconnect();
+    if (err != ESP_OK) ESP_LOGW(TAG, "esp_wifi_disconnect: %s", esp_err_to_name(err));
+    err = esp_wifi_set_config(WIFI_IF_STA, &cfg);
+    if (err != ESP_OK) {
+        // Giữ nguyên trạng thái, thử lại ở lần mất kết nối sau
+        ESP_LOGW(TAG, "Failed to clear cached AP (%s), will retry", esp_err_to_name(err));
+        return;
+    }
+    storage_restore_flash();
+#if CONFIG_FAST_CONNECT_STATIC_IP
+    static_ip_revert();
+#endif
+    directed = false;
+    cache_erase();
+    cache_valid = false;
+    ESP_LOGW(TAG, "Directed connect failed, falling back to full scan");
+    // Kết nối lại ngay với cấu hình mới, không phụ thuộc vào lần thử lại của app_network:
+    err = esp_wifi_connect();
+    if (err != ESP_OK) ESP_LOGW(TAG, "esp_wifi_connect: %s", esp_err_to_name(err));
+}
+
+// ======== Event Handler ========
+static void event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    if (base == WIFI_EVENT && id == WIFI_EVENT_STA_CONNECTED) {
+#if CONFIG_FAST_CONNECT_STATIC_IP
+        if (static_ip_pending) static_ip_apply();
+#endif
+    } else if (base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED) {
+        // AP có thể đã bị thay/đổi kênh: sau vài lần thất bại liên tiếp thì quét lại
+        if (directed && ++directed_failures >= CONFIG_FAST_CONNECT_MAX_RETRIES) {
+            fallback_full_scan();
+        }
+    } else if (base == IP_EVENT && id == IP_EVENT_STA_GOT_IP) {
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)data;
+        directed_failures = 0;
+        if (directed) storage_restore_flash();
+        ESP_LOGI(TAG, "Got IP after %lld ms (%s)", esp_timer_get_time() / 1000,
+                 directed ? "directed" : "full scan");
+        // Cập nhật cache nếu AP hoặc IP thay đổi (hạn chế ghi flash):
+        wifi_ap_record_t ap;
+        wifi_config_t cfg;
+        if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK ||
+            esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) return;
+        fast_connect_cache_t fresh;
+        memset(&fresh, 0, sizeof(fresh));   // memcmp bên dưới so cả padding
+        memcpy(fresh.ssid, cfg.sta.ssid, sizeof(fresh.ssid));
+        memcpy(fresh.bssid, ap.bssid, sizeof(fresh.bssid));
+        fresh.channel = ap.primary;
+        fresh.ip = event->ip_info.ip;
+        fresh.netmask = event->ip_info.netmask;
+        fresh.gw = event->ip_info.gw;
+        esp_netif_dns_info_t dns;
+        if (esp_netif_get_dns_info(event->esp_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK)
+            fresh.dns = dns.ip.u_addr.ip4;
+        if (!cache_valid || memcmp(&fresh, &cache, sizeof(cache)) != 0) {
+            cache = fresh;
+            cache_valid = true;
+            cache_save();
+            ESP_LOGI(TAG, "Cached AP channel %d, IP " IPSTR, cache.channel, IP2STR(&cache.ip));
+        }
+    } else if (base == RMAKER_COMMON_EVENT && id == RMAKER_MQTT_EVENT_CONNECTED) {
+#if CONFIG_FAST_CONNECT_STATIC_IP
+        if (static_ip_active) esp_timer_stop(static_ip_timer);
+#endif
+        if (mqtt_logged) return;
+        mqtt_logged = true;
+        ESP_LOGI(TAG, "Time to MQTT connected: %lld ms (%s)", esp_timer_get_time() / 1000,
+                 directed ? "fast connect" : (cache_valid ? "full scan, cache refreshed" : "full scan"));
+    }
+}
+
+// ======== Init ========
+void fast_connect_init(void) {
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, event_handler, NULL);
+    esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, event_handler, NULL);
+    esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, event_handler, NULL);
+    esp_event_handler_register(RMAKER_COMMON_EVENT, RMAKER_MQTT_EVENT_CONNECTED, event_handler, NULL);
+
+    cache_valid = cache_load();
+    if (!cache_valid) {
+        ESP_LOGI(TAG, "No cached AP, using full scan");
+        return;
+    }
+#if CONFIG_FAST_CONNECT_ENABLE
+    wifi_config_t cfg;
+    if (esp_wifi_get_config(WIFI_IF_STA, &cfg) != ESP_OK) return;
+    // Chỉ dùng cache nếu vẫn là mạng đã provisioning:
+    if (cfg.sta.ssid[0] == 0 ||
+        memcmp(cfg.sta.ssid, cache.ssid, sizeof(cache.ssid)) != 0) {
+        ESP_LOGI(TAG, "Cached AP does not match provisioned SSID, ignoring");
+        cache_erase();
+        cache_valid = false;
+        return;
+    }
+    orig_scan_method = cfg.sta.scan_method;    // Khôi phục khi quay về quét đầy đủ
+    memcpy(cfg.sta.bssid, cache.bssid, sizeof(cfg.sta.bssid));
+    cfg.sta.bssid_set = true;
+    cfg.sta.channel = cache.channel;
+    cfg.sta.scan_method = WIFI_FAST_SCAN;
+    // Cấu hình STA chỉ hợp lệ khi đã ở chế độ STA; chỉ ghim trong RAM:
+    esp_wifi_set_mode(WIFI_MODE_STA);
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    if (esp_wifi_set_config(WIFI_IF_STA, &cfg) != ESP_OK) {
+        storage_restore_flash();
+        ESP_LOGW(TAG, "Failed to apply cached AP, using full scan");
+        return;
+    }
+#if CONFIG_FAST_CONNECT_STATIC_IP
+    const esp_timer_create_args_t timer_args = {
+        .callback = static_ip_timeout_cb,
+        .name = "static_ip_check"
+    };
+    if (esp_timer_create(&timer_args, &static_ip_timer) == ESP_OK)
+        static_ip_pending = true;
+#endif
+    directed = true;
+    ESP_LOGI(TAG, "Directed connect to " MACSTR " on channel %d",
+             MAC2STR(cache.bssid), cache.channel);
+#endif
+}
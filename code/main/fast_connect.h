@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_netif_ip_addr.h"
+#include "sdkconfig.h"
+
+// ==================== Fast Wi-Fi reconnect ====================
+// Lưu kênh, BSSID và IP lease của AP cuối cùng vào NVS. Khi khởi động lại,
+// kết nối thẳng tới AP đó (không quét toàn bộ kênh); nếu thất bại thì tự
+// động quay về chế độ quét đầy đủ + DHCP.
+
+#define FAST_CONNECT_NVS_NAMESPACE  "fast_conn"
+#define FAST_CONNECT_NVS_KEY        "ap"
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t bssid[6];
+    uint8_t channel;
+    esp_ip4_addr_t ip;
+    esp_ip4_addr_t netmask;
+    esp_ip4_addr_t gw;
+    esp_ip4_addr_t dns;
+} fast_connect_cache_t;
+
+// ==================== Functions ====================
+// Gọi sau app_network_init() và trước app_network_start().
+void fast_connect_init(void);
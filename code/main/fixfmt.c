@@ -0,0 +1,137 @@
+// ==== Includes ====
+#include "fixfmt.h"
+
+// ======== Digits ========
+// Ghi giá trị vào tmp theo thứ tự ngược (từ phải sang trái), trả về số ký tự.
+static size_t render_reverse(char *tmp, int32_t value, uint8_t frac) {
+    uint32_t mag = (value < 0) ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+    size_t n = 0;
+    if (frac > FIXFMT_MAX_FRAC) frac = FIXFMT_MAX_FRAC;
+    for (uint8_t i = 0; i < frac; i++) {
+        tmp[n++] = '0' + (mag % 10);
+        mag /= 10;
+    }
+    if (frac) tmp[n++] = '.';
+    do {
+        tmp[n++] = '0' + (mag % 10);
+        mag /= 10;
+    } while (mag);
+    if (value < 0) tmp[n++] = '-';
+    return n;
+}
+
+static size_t str_len(const char *s) {
+    size_t n = 0;
+    if (s) while (s[n]) n++;
+    return n;
+}
+
+// ======== Cell ========
+size_t fixfmt_cell(char *dst, size_t width, int32_t value, uint8_t frac, const char *unit) {
+    char tmp[16];
+    size_t n = render_reverse(tmp, value, frac);
+    size_t ulen = str_len(unit);
+    if (n + ulen > width) {
+        for (size_t i = 0; i < width; i++) dst[i] = FIXFMT_OVERFLOW;
+        // Giữ lại đơn vị nếu còn chỗ để người đọc biết ô nào bị tràn:
+        if (ulen < width) {
+            for (size_t i = 0; i < ulen; i++) dst[width - ulen + i] = unit[i];
+        }
+        dst[width] = '\0';
+        return width;
+    }
+    size_t pad = width - n - ulen;
+    size_t pos = 0;
+    while (pos < pad) dst[pos++] = ' ';
+    while (n) dst[pos++] = tmp[--n];
+    for (size_t i = 0; i < ulen; i++) dst[pos++] = unit[i];
+    dst[pos] = '\0';
+    return width;
+}
+
+// ======== Append ========
+size_t fixfmt_append_str(char *dst, size_t cap, size_t len, const char *str) {
+    if (cap == 0) return 0;
+    while (str && *str && len + 1 < cap) dst[len++] = *str++;
+    dst[len] = '\0';
+    return len;
+}
+
+size_t fixfmt_append(char *dst, size_t cap, size_t len, int32_t value, uint8_t frac, const char *unit) {
+    char tmp[16];
+    size_t n = render_reverse(tmp, value, frac);
+    if (cap == 0) return 0;
+    while (n && len + 1 < cap) dst[len++] = tmp[--n];
+    dst[len] = '\0';
+    return fixfmt_append_str(dst, cap, len, unit);
+}
+
+// ======== Benchmark ========
+#if CONFIG_FIXFMT_BENCHMARK
+#include <stdio.h>
+#include <stdbool.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "FIXFMT";
+#define BENCH_ITERATIONS  1000
+#define BENCH_STACK_SIZE  4096
+
+// Mỗi phương pháp chạy trong một task mới tạo, nên high water mark chỉ phản ánh
+// stack của chính phương pháp đó (task chính đã dùng stack sâu hơn nhiều lúc khởi động).
+typedef struct {
+    bool use_printf;
+    TaskHandle_t caller;
+    int64_t time_us;
+    unsigned stack_used;
+} bench_run_t;
+
+static void bench_task(void *arg) {
+    bench_run_t *run = arg;
+    char buf[32];
+    volatile float v = 12.345f;
+    volatile size_t sink = 0;
+    int64_t t0 = esp_timer_get_time();
+    if (run->use_printf) {
+        // snprintf (đường cũ trong report_timer_cb):
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            sink += snprintf(buf, sizeof(buf), "%.2f    ", v + i);
+        }
+    } else {
+        // fixfmt (bao gồm cả bước chuyển float -> fixed-point):
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            sink += fixfmt_cell(buf, 12, fixfmt_scale(v + i, 2), 2, " ppm");
+        }
+    }
+    run->time_us = esp_timer_get_time() - t0;
+    run->stack_used = BENCH_STACK_SIZE - (unsigned)uxTaskGetStackHighWaterMark(NULL);
+    (void)sink;
+    xTaskNotifyGive(run->caller);
+    vTaskDelete(NULL);
+}
+
+static bool bench_run(bench_run_t *run) {
+    run->caller = xTaskGetCurrentTaskHandle();
+    if (xTaskCreate(bench_task, "fixfmt_bench", BENCH_STACK_SIZE, run,
+                    uxTaskPriorityGet(NULL), NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create benchmark task");
+        return false;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return true;
+}
+
+void fixfmt_benchmark(void) {
+    bench_run_t fixfmt = {.use_printf = false};
+    bench_run_t snp = {.use_printf = true};
+    if (!bench_run(&fixfmt) || !bench_run(&snp)) return;
+    ESP_LOGI(TAG, "%d iterations: snprintf %lld us, fixfmt %lld us (x%.1f)",
+             BENCH_ITERATIONS, snp.time_us, fixfmt.time_us,
+             fixfmt.time_us > 0 ? (double)snp.time_us / fixfmt.time_us : 0.0);
+    // Stack đã dùng (byte) trong task mới, gồm cả phần khung task giống nhau ở cả hai:
+    ESP_LOGI(TAG, "Stack used: fixfmt %u bytes, snprintf %u bytes",
+             fixfmt.stack_used, snp.stack_used);
+}
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+
+// ==================== Fixed-point formatter ====================
+// Định dạng số fixed-point (value / 10^frac) thành chuỗi mà không dùng
+// printf, varargs, heap hay phép tính số thực. Dùng cho LCD và param RainMaker.
+
+#define FIXFMT_MAX_FRAC   4
+#define FIXFMT_OVERFLOW   '#'   // Ký tự lấp đầy khi giá trị không vừa ô
+
+// Chuyển float sang fixed-point với frac chữ số thập phân (làm tròn).
+// Phép nhân float duy nhất nằm ở đây; phần định dạng chỉ dùng số nguyên.
+static inline int32_t fixfmt_scale(float v, uint8_t frac) {
+    static const int32_t pow10[FIXFMT_MAX_FRAC + 1] = {1, 10, 100, 1000, 10000};
+    float s = v * pow10[frac > FIXFMT_MAX_FRAC ? FIXFMT_MAX_FRAC : frac];
+    if (s >= 2147483647.0f) return INT32_MAX;
+    if (s <= -2147483647.0f) return -INT32_MAX;
+    return (int32_t)(s + (s >= 0 ? 0.5f : -0.5f));
+}
+
+// ==================== Functions ====================
+// Ghi giá trị vào ô rộng width ký tự, căn phải, kèm đơn vị (unit có thể NULL).
+// dst phải có ít nhất width + 1 byte. Nếu không vừa, ô được lấp bằng FIXFMT_OVERFLOW.
+// Trả về width.
+size_t fixfmt_cell(char *dst, size_t width, int32_t value, uint8_t frac, const char *unit);
+
+// Nối chuỗi str và giá trị (kèm đơn vị) vào dst tại vị trí len, không vượt cap.
+// Trả về độ dài mới (không tính '\0'). Bị cắt bớt nếu không đủ chỗ.
+size_t fixfmt_append_str(char *dst, size_t cap, size_t len, const char *str);
+size_t fixfmt_append(char *dst, size_t cap, size_t len, int32_t value, uint8_t frac, const char *unit);
+
+#if CONFIG_FIXFMT_BENCHMARK
+// So sánh thời gian và stack của fixfmt với snprintf("%.2f"), in kết quả ra log.
+void fixfmt_benchmark(void);
+#endif
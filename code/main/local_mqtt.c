@@ -0,0 +1,153 @@
+// ==== Includes ====
+#include "local_mqtt.h"
+
+#if CONFIG_LOCAL_MQTT_ENABLE
+#include <time.h>
+#include <esp_rmaker_core.h>
+#include "fixfmt.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "mqtt_client.h"
+
+static const char *TAG = "LOCAL_MQTT";
+
+// Mỗi khung JSON tối đa ~150 byte:
+#define FRAME_JSON_MAX     152
+#define PAYLOAD_SIZE       (96 + CONFIG_LOCAL_MQTT_BATCH_SIZE * FRAME_JSON_MAX)
+#define TASK_STACK_SIZE    3072
+#define TASK_PRIORITY      3
+
+static QueueHandle_t frame_queue = NULL;
+static esp_mqtt_client_handle_t client = NULL;
+static volatile bool connected = false;
+static uint32_t dropped = 0;               // Số khung bị bỏ (hàng đợi đầy / publish lỗi)
+static portMUX_TYPE dropped_lock = portMUX_INITIALIZER_UNLOCKED;   // esp_timer task + task này
+static char payload[PAYLOAD_SIZE];
+static uint32_t next_seq = 0;              // Chỉ dùng trong local_mqtt_submit (esp_timer task)
+
+// ======== MQTT Events ========
+static void mqtt_event_handler(void *arg, esp_event_base_t base, int32_t id, void *data) {
+    switch ((esp_mqtt_event_id_t)id) {
+    case MQTT_EVENT_CONNECTED:
+        connected = true;
+        ESP_LOGI(TAG, "Connected to %s", CONFIG_LOCAL_MQTT_BROKER_URI);
+        break;
+    case MQTT_EVENT_DISCONNECTED:
+        connected = false;
+        ESP_LOGW(TAG, "Disconnected, %u frames queued", (unsigned)uxQueueMessagesWaiting(frame_queue));
+        break;
+    default:
+        break;
+    }
+}
+
+// ======== Dropped counter ========
+static void dropped_add(uint32_t n) {
+    taskENTER_CRITICAL(&dropped_lock);
+    dropped += n;
+    taskEXIT_CRITICAL(&dropped_lock);
+}
+
+static uint32_t dropped_get(void) {
+    taskENTER_CRITICAL(&dropped_lock);
+    uint32_t n = dropped;
+    taskEXIT_CRITICAL(&dropped_lock);
+    return n;
+}
+
+// ======== JSON ========
+static size_t append_int(size_t len, const char *key, int32_t value, uint8_t frac) {
+    len = fixfmt_append_str(payload, sizeof(payload), len, key);
+    return fixfmt_append(payload, sizeof(payload), len, value, frac, NULL);
+}
+
+// Uptime dạng giây có 3 chữ số thập phân (ms), không tràn int32 như khi ghi ms:
+static size_t append_uptime(size_t len, int64_t uptime_ms) {
+    char frac[8];
+    len = append_int(len, ",\"uptime\":", (int32_t)(uptime_ms / 1000), 0);
+    fixfmt_append(frac, sizeof(frac), 0, (int32_t)(uptime_ms % 1000), 3, NULL);   // "0.xxx"
+    return fixfmt_append_str(payload, sizeof(payload), len, frac + 1);
+}
+
+static size_t append_frame(size_t len, const local_mqtt_frame_t *f) {
+    len = append_int(len, "{\"seq\":", (int32_t)f->seq, 0);
+    len = append_uptime(len, f->uptime_ms);
+    len = append_int(len, ",\"ts\":", f->ts, 0);
+    len = append_int(len, ",\"co\":", f->co_ppm, 2);
+    len = append_int(len, ",\"pm25\":", f->pm25, 3);
+    len = append_int(len, ",\"ratio\":", f->ratio, 3);
+    len = append_int(len, ",\"co_lvl\":", f->co_level, 0);
+    len = append_int(len, ",\"pm_lvl\":", f->pm_level, 0);
+    len = append_int(len, ",\"rise\":", f->rising, 0);
+    return fixfmt_append_str(payload, sizeof(payload), len, "}");
+}
+
+// ======== Publisher Task ========
+// Gom tối đa BATCH_SIZE khung thành một message và publish. Trả về false nếu lỗi.
+static bool publish_batch(void) {
+    local_mqtt_frame_t frame;
+    size_t len = fixfmt_append_str(payload, sizeof(payload), 0, "{\"node\":\"");
+    len = fixfmt_append_str(payload, sizeof(payload), len, esp_rmaker_get_node_id());
+    len = append_int(len, "\",\"dropped\":", (int32_t)dropped_get(), 0);
+    len = fixfmt_append_str(payload, sizeof(payload), len, ",\"frames\":[");
+    int n = 0;
+    while (n < CONFIG_LOCAL_MQTT_BATCH_SIZE && xQueueReceive(frame_queue, &frame, 0) == pdTRUE) {
+        if (n++) len = fixfmt_append_str(payload, sizeof(payload), len, ",");
+        len = append_frame(len, &frame);
+    }
+    len = fixfmt_append_str(payload, sizeof(payload), len, "]}");
+    if (esp_mqtt_client_publish(client, CONFIG_LOCAL_MQTT_TOPIC, payload, len,
+                                CONFIG_LOCAL_MQTT_QOS, 0) < 0) {
+        dropped_add(n);
+        ESP_LOGW(TAG, "Publish failed, dropped %d frames", n);
+        return false;
+    }
+    return true;
+}
+
+static void local_mqtt_task(void *arg) {
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_LOCAL_MQTT_PUBLISH_INTERVAL_MS));
+        // Chưa kết nối: giữ khung trong hàng đợi (khung cũ nhất sẽ bị bỏ khi đầy).
+        // Đã kết nối: xả hết hàng đợi theo từng lô để tồn đọng sau khi mất kết nối
+        // không kéo dài mãi.
+        while (connected && uxQueueMessagesWaiting(frame_queue) > 0) {
+            if (!publish_batch()) break;
+        }
+    }
+}
+
+// ======== Submit (gọi từ report timer) ========
+bool local_mqtt_submit(const local_mqtt_frame_t *frame) {
+    if (!frame_queue) return false;
+    local_mqtt_frame_t f = *frame;
+    f.seq = next_seq++;
+    if (xQueueSend(frame_queue, &f, 0) == pdTRUE) return true;
+    // Hàng đợi đầy: bỏ khung cũ nhất, giữ khung mới
+    local_mqtt_frame_t oldest;
+    xQueueReceive(frame_queue, &oldest, 0);
+    dropped_add(1);
+    xQueueSend(frame_queue, &f, 0);
+    return false;
+}
+
+// ======== Init ========
+void local_mqtt_init(void) {
+    frame_queue = xQueueCreate(CONFIG_LOCAL_MQTT_QUEUE_LEN, sizeof(local_mqtt_frame_t));
+    esp_mqtt_client_config_t cfg = {
+        .broker.address.uri = CONFIG_LOCAL_MQTT_BROKER_URI,
+    };
+    client = esp_mqtt_client_init(&cfg);
+    if (!client || !frame_queue) {
+        ESP_LOGE(TAG, "Failed to create local MQTT client");
+        return;
+    }
+    esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
+    esp_mqtt_client_start(client);
+    xTaskCreate(local_mqtt_task, "local_mqtt", TASK_STACK_SIZE, NULL, TASK_PRIORITY, NULL);
+    ESP_LOGI(TAG, "Local MQTT sink -> %s, topic %s, QoS %d",
+             CONFIG_LOCAL_MQTT_BROKER_URI, CONFIG_LOCAL_MQTT_TOPIC, CONFIG_LOCAL_MQTT_QOS);
+}
+#endif
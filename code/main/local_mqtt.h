@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+// ==================== Local MQTT sink ====================
+// Gửi dữ liệu cảm biến trực tiếp tới broker MQTT nội bộ (on-prem), song song với
+// RainMaker. Khung dữ liệu được đưa vào hàng đợi có giới hạn (không bao giờ block
+// timer báo cáo); một task riêng gom theo lô và publish theo chu kỳ cấu hình.
+// Khi hàng đợi đầy, khung cũ nhất bị bỏ.
+
+typedef struct {
+    int64_t uptime_ms;      // esp_timer (ms từ lúc khởi động), luôn có, đơn điệu tăng
+    uint32_t seq;           // Số thứ tự khung, do local_mqtt_submit gán (khoảng trống = khung bị bỏ)
+    int32_t ts;             // Epoch (giây), 0 nếu chưa đồng bộ thời gian
+    int32_t co_ppm;         // CO ppm x100
+    int32_t pm25;           // PM2.5 x1000
+    int32_t ratio;          // Rs/R0 x1000
+    uint8_t co_level;
+    uint8_t pm_level;
+    bool rising;            // Cảnh báo tăng nhanh đang bật
+} local_mqtt_frame_t;
+
+// ==================== Functions ====================
+#if CONFIG_LOCAL_MQTT_ENABLE
+void local_mqtt_init(void);
+// Không block: trả về false nếu phải bỏ khung cũ nhất để nhường chỗ.
+bool local_mqtt_submit(const local_mqtt_frame_t *frame);
+#else
+static inline void local_mqtt_init(void) {}
+static inline bool local_mqtt_submit(const local_mqtt_frame_t *frame) { (void)frame; return true; }
+#endif
@@ -0,0 +1,75 @@
+// ==== Includes ====
+#include "rise_detect.h"
+
+// ======== Init / Reset ========
+void rise_detector_init(rise_detector_t *d, const rise_params_t *params) {
+    d->params = params;
+    rise_detector_reset(d);
+}
+
+void rise_detector_reset(rise_detector_t *d) {
+    d->baseline = 0;
+    d->level = 0;
+    d->slope = 0;
+    d->cusum = 0;
+    d->last = 0;
+    d->samples = 0;
+    d->alarm = false;
+}
+
+// Chấp nhận mức hiện tại làm baseline mới:
+static void rebaseline(rise_detector_t *d) {
+    d->baseline = d->level;
+    d->cusum = 0;
+}
+
+// ======== Update ========
+bool rise_detector_update(rise_detector_t *d, float value, float dt_s) {
+    const rise_params_t *p = d->params;
+    if (d->samples == 0) {
+        d->baseline = value;
+        d->level = value;
+        d->last = value;
+        d->samples = 1;
+        return false;
+    }
+    if (d->samples < p->warmup) {
+        // Warmup: baseline = trung bình cộng các mẫu đầu (không lấy từ 1 mẫu nhiễu)
+        d->samples++;
+        d->baseline += (value - d->baseline) / d->samples;
+        d->level = d->baseline;
+        if (dt_s > 0)
+            d->slope += p->slope_alpha * ((value - d->last) / dt_s - d->slope);
+        d->last = value;
+        return false;
+    }
+    // Độ dốc tức thời, làm mượt bằng EWMA:
+    if (dt_s > 0) {
+        float inst_slope = (value - d->last) / dt_s;
+        d->slope += p->slope_alpha * (inst_slope - d->slope);
+    }
+    d->last = value;
+    d->level += p->slope_alpha * (value - d->level);
+    // CUSUM một phía trên độ lệch dương so với baseline, có giới hạn trên:
+    float s = d->cusum + (value - d->baseline) - p->drift;
+    float cap = 2 * p->threshold;
+    d->cusum = (s > 0) ? ((s < cap) ? s : cap) : 0;
+    // Baseline luôn bám theo, trừ khi CUSUM đã tích luỹ quá nửa ngưỡng hoặc đang
+    // báo động (tránh "đuổi theo" đám cháy âm ỉ). Không đóng băng ở mọi bước
+    // CUSUM > 0: như vậy baseline chỉ học từ các mẫu thấp và bị lệch xuống.
+    if (!d->alarm && d->cusum <= p->threshold * 0.5f)
+        d->baseline += p->alpha * (value - d->baseline);
+    // Hysteresis theo độ dốc: bật khi > min_slope, tắt khi < min_slope / 2.
+    if (d->alarm) {
+        if (d->slope < p->min_slope * 0.5f) {
+            d->alarm = false;
+            rebaseline(d);
+        }
+    } else if (d->cusum > p->threshold) {
+        if (d->slope > p->min_slope)
+            d->alarm = true;
+        else if (d->slope < p->min_slope * 0.5f)
+            rebaseline(d);      // Dịch mức rồi đứng yên: không phải tăng nhanh
+    }
+    return d->alarm;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// ==================== Rapid-rise detector ====================
+// Bộ phát hiện tăng nhanh (streaming) cho từng kênh CO / PM2.5:
+// - Baseline: trung bình các mẫu warmup, sau đó EWMA (dừng khi CUSUM > threshold / 2)
+// - EWMA của độ dốc (đơn vị/giây)
+// - CUSUM một phía trên độ lệch dương so với baseline (giới hạn 2 * threshold)
+// Báo động khi CUSUM vượt ngưỡng VÀ độ dốc > min_slope; tắt khi độ dốc < min_slope / 2.
+// Khi tắt báo động, hoặc khi nồng độ đứng yên ở mức mới (CUSUM cao nhưng độ dốc
+// phẳng), baseline được đặt lại bằng mức hiện tại để không báo động mãi.
+// Bộ nhớ cố định: mỗi kênh chỉ là một rise_detector_t.
+
+typedef struct {
+    float alpha;        // Hệ số EWMA cho baseline (0..1)
+    float slope_alpha;  // Hệ số EWMA cho độ dốc (0..1)
+    float drift;        // Độ lệch cho phép mỗi mẫu (k của CUSUM)
+    float threshold;    // Ngưỡng CUSUM (h)
+    float min_slope;    // Độ dốc tối thiểu (đơn vị/giây) để báo tăng nhanh
+    uint16_t warmup;    // Số mẫu bỏ qua sau khi khởi động
+} rise_params_t;
+
+typedef struct {
+    const rise_params_t *params;
+    float baseline;
+    float level;        // EWMA nhanh của nồng độ (dùng khi đặt lại baseline)
+    float slope;
+    float cusum;
+    float last;
+    uint16_t samples;
+    bool alarm;
+} rise_detector_t;
+
+// Ngưỡng mặc định cho CO (ppm) và PM2.5 (ug/m³), chu kỳ lấy mẫu 200ms.
+// Đã kiểm tra bằng tools/rise_replay với nhiễu tới ±1.0 ppm (CO) và ±10 ug/m³ (PM2.5);
+// nhiễu lớn hơn cần chỉnh lại drift / threshold / min_slope.
+#define RISE_CO_ALPHA           0.02f
+#define RISE_CO_SLOPE_ALPHA     0.03f
+#define RISE_CO_DRIFT           0.5f
+#define RISE_CO_THRESHOLD       8.0f
+#define RISE_CO_MIN_SLOPE       0.2f    // 12 ppm/phút
+#define RISE_PM25_ALPHA         0.02f
+#define RISE_PM25_SLOPE_ALPHA   0.03f
+#define RISE_PM25_DRIFT         5.0f
+#define RISE_PM25_THRESHOLD     200.0f
+#define RISE_PM25_MIN_SLOPE     3.0f    // 180 ug/m³/phút
+#define RISE_WARMUP_SAMPLES     50      // ~10s ở 200ms/mẫu
+
+// ==================== Functions ====================
+void rise_detector_init(rise_detector_t *d, const rise_params_t *params);
+// Đưa một mẫu mới vào (dt_s: khoảng thời gian từ mẫu trước, giây).
+// Trả về true khi kênh đang ở trạng thái "tăng nhanh".
+bool rise_detector_update(rise_detector_t *d, float value, float dt_s);
+void rise_detector_reset(rise_detector_t *d);
@@ -0,0 +1,250 @@
+// Replay trace qua rise_detect.c trên máy tính (không cần ESP-IDF) để kiểm tra
+// ngưỡng phát hiện tăng nhanh.
+//
+// Build + chạy (từ thư mục này):
+//   cc -O2 -I../../main rise_replay.c ../../main/rise_detect.c -o rise_replay
+//   ./rise_replay                 # ma trận trace tổng hợp (sinh trong lúc chạy)
+//   ./rise_replay trace.csv ...   # trace thu thập thật từ thiết bị
+//
+// Trace tổng hợp: mỗi kịch bản (sạch, bậc nhỏ, trôi chậm, tăng nhanh, bậc lớn)
+// được chạy với nhiều mức nhiễu đều ±noise và nhiều seed cố định.
+//
+// Trace CSV: mỗi dòng một mẫu (chu kỳ 200ms), header dạng "# key: value":
+//   channel       co | pm25 (chọn bộ tham số RISE_CO_* / RISE_PM25_*)
+//   expect_alarm  yes | no | any
+//   onset_s       thời điểm bắt đầu tăng (với expect_alarm: yes)
+//   max_latency_s độ trễ phát hiện tối đa tính từ onset_s
+//   max_alarm_s   tổng thời gian báo động tối đa (mặc định: không giới hạn)
+// Mọi trace đều yêu cầu báo động đã tắt ở cuối trace.
+// Trả về 0 nếu mọi trace đạt, 1 nếu có trace không đạt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "rise_detect.h"
+
+#define DT_S    0.2f    // READ_INTERVAL_MS
+#define SEEDS   20
+
+static const rise_params_t co_params = {
+    .alpha = RISE_CO_ALPHA,
+    .slope_alpha = RISE_CO_SLOPE_ALPHA,
+    .drift = RISE_CO_DRIFT,
+    .threshold = RISE_CO_THRESHOLD,
+    .min_slope = RISE_CO_MIN_SLOPE,
+    .warmup = RISE_WARMUP_SAMPLES
+};
+static const rise_params_t pm25_params = {
+    .alpha = RISE_PM25_ALPHA,
+    .slope_alpha = RISE_PM25_SLOPE_ALPHA,
+    .drift = RISE_PM25_DRIFT,
+    .threshold = RISE_PM25_THRESHOLD,
+    .min_slope = RISE_PM25_MIN_SLOPE,
+    .warmup = RISE_WARMUP_SAMPLES
+};
+
+// ======== Expectation / Result ========
+typedef struct {
+    char expect[8];         // "yes" | "no" | "any"
+    float onset_s;
+    float max_latency_s;    // < 0: không giới hạn
+    float max_alarm_s;      // < 0: không giới hạn
+} expect_t;
+
+typedef struct {
+    rise_detector_t d;
+    int n;
+    int alarm_samples;
+    int first_alarm;
+    float max_cusum;
+} run_t;
+
+static void run_begin(run_t *r, const rise_params_t *params) {
+    memset(r, 0, sizeof(*r));
+    rise_detector_init(&r->d, params);
+    r->first_alarm = -1;
+}
+
+static void run_sample(run_t *r, float value) {
+    if (value < 0) value = 0;       // Cảm biến không trả giá trị âm
+    if (rise_detector_update(&r->d, value, DT_S)) {
+        r->alarm_samples++;
+        if (r->first_alarm < 0) r->first_alarm = r->n;
+    }
+    if (r->d.cusum > r->max_cusum) r->max_cusum = r->d.cusum;
+    r->n++;
+}
+
+static int run_check(const run_t *r, const expect_t *e) {
+    float alarm_s = r->alarm_samples * DT_S;
+    int ok = r->n > 0 && !r->d.alarm;
+    if (!strcmp(e->expect, "no")) ok = ok && r->first_alarm < 0;
+    if (!strcmp(e->expect, "yes")) {
+        ok = ok && r->first_alarm >= 0 && r->first_alarm * DT_S >= e->onset_s;
+        if (e->max_latency_s >= 0)
+            ok = ok && r->first_alarm * DT_S - e->onset_s <= e->max_latency_s;
+    }
+    if (e->max_alarm_s >= 0) ok = ok && alarm_s <= e->max_alarm_s;
+    return ok;
+}
+
+static void run_print(const char *name, const run_t *r, int ok) {
+    printf("%-4s %-32s first_alarm=", ok ? "PASS" : "FAIL", name);
+    if (r->first_alarm >= 0) printf("%7.1fs", r->first_alarm * DT_S);
+    else printf("%8s", "-");
+    printf(" alarm_time=%6.1fs max_cusum=%7.1f end=%s\n",
+           r->alarm_samples * DT_S, r->max_cusum, r->d.alarm ? "ALARM" : "clear");
+}
+
+// ======== Synthetic traces ========
+typedef enum { SHAPE_FLAT, SHAPE_STEP, SHAPE_RAMP, SHAPE_DRIFT } shape_t;
+
+typedef struct {
+    const char *name;
+    shape_t shape;
+    float amount;           // STEP: độ lớn bậc, RAMP/DRIFT: tốc độ (đơn vị/giây)
+    float duration_s;
+    expect_t expect;
+} scenario_t;
+
+typedef struct {
+    const char *name;
+    const rise_params_t *params;
+    float base;
+    const float *noise;     // Các mức nhiễu ±noise cần kiểm tra
+    int noise_count;
+    const scenario_t *scenarios;
+    int scenario_count;
+} channel_t;
+
+// Bậc/tăng bắt đầu ở giây 60, tăng kéo dài 60s rồi giữ nguyên.
+static float shape_value(const scenario_t *s, float base, float t) {
+    switch (s->shape) {
+    case SHAPE_STEP:  return base + (t >= 60 ? s->amount : 0);
+    case SHAPE_RAMP: {
+        float dt = t - 60;
+        if (dt < 0) dt = 0;
+        if (dt > 60) dt = 60;
+        return base + s->amount * dt;
+    }
+    case SHAPE_DRIFT: return base + s->amount * t;
+    default:          return base;
+    }
+}
+
+// xorshift32: giống nhau trên mọi máy, không phụ thuộc rand() của libc
+static uint32_t rng_next(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static float rng_uniform(uint32_t *state, float amp) {
+    return ((rng_next(state) >> 8) * (1.0f / 16777216.0f) * 2.0f - 1.0f) * amp;
+}
+
+static const float co_noise[] = {0.2f, 0.4f, 0.6f, 1.0f};
+static const scenario_t co_scenarios[] = {
+    {"clean_air",    SHAPE_FLAT,  0,     1800, {"no",  0,  -1, -1}},
+    {"step_small",   SHAPE_STEP,  0.5f,  1860, {"no",  0,  -1, -1}},
+    {"slow_drift",   SHAPE_DRIFT, 0.01f, 1800, {"no",  0,  -1, -1}},
+    {"ramp",         SHAPE_RAMP,  0.3f,  420,  {"yes", 60, 15, -1}},
+    {"step_plateau", SHAPE_STEP,  4.0f,  1860, {"any", 0,  -1, 30}},
+};
+static const float pm25_noise[] = {2.0f, 6.0f, 10.0f};
+static const scenario_t pm25_scenarios[] = {
+    {"clean_air",    SHAPE_FLAT,  0,     1800, {"no",  0,  -1, -1}},
+    {"step_small",   SHAPE_STEP,  10.0f, 1860, {"no",  0,  -1, -1}},
+    {"slow_drift",   SHAPE_DRIFT, 0.1f,  1800, {"no",  0,  -1, -1}},
+    {"ramp",         SHAPE_RAMP,  5.0f,  420,  {"yes", 60, 15, -1}},
+    {"step_plateau", SHAPE_STEP,  100.0f, 1860, {"any", 0, -1, 30}},
+};
+static const channel_t channels[] = {
+    {"co", &co_params, 2.0f, co_noise, sizeof(co_noise) / sizeof(co_noise[0]),
+     co_scenarios, sizeof(co_scenarios) / sizeof(co_scenarios[0])},
+    {"pm25", &pm25_params, 30.0f, pm25_noise, sizeof(pm25_noise) / sizeof(pm25_noise[0]),
+     pm25_scenarios, sizeof(pm25_scenarios) / sizeof(pm25_scenarios[0])},
+};
+
+static int replay_synthetic(void) {
+    int failed = 0;
+    for (size_t c = 0; c < sizeof(channels) / sizeof(channels[0]); c++) {
+        const channel_t *ch = &channels[c];
+        for (int s = 0; s < ch->scenario_count; s++) {
+            const scenario_t *sc = &ch->scenarios[s];
+            for (int k = 0; k < ch->noise_count; k++) {
+                for (int seed = 1; seed <= SEEDS; seed++) {
+                    uint32_t state = 0x9E3779B9u * (uint32_t)(seed + 256 * (s + 16 * (k + 16 * c)));
+                    if (!state) state = 1;
+                    run_t r;
+                    run_begin(&r, ch->params);
+                    int samples = (int)(sc->duration_s / DT_S);
+                    for (int i = 0; i < samples; i++) {
+                        float v = shape_value(sc, ch->base, i * DT_S) + rng_uniform(&state, ch->noise[k]);
+                        run_sample(&r, v);
+                    }
+                    int ok = run_check(&r, &sc->expect);
+                    char name[64];
+                    snprintf(name, sizeof(name), "%s/%s ±%g #%d", ch->name, sc->name, ch->noise[k], seed);
+                    run_print(name, &r, ok);
+                    if (!ok) failed++;
+                }
+            }
+        }
+    }
+    return failed;
+}
+
+// ======== CSV traces ========
+static int replay_csv(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 0;
+    }
+    char line[128];
+    expect_t e = {"any", 0, -1, -1};
+    const rise_params_t *params = &co_params;
+    run_t r;
+    int started = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') {
+            char key[32], val[32];
+            if (sscanf(line, "# %31[^:]: %31s", key, val) != 2) continue;
+            if (!strcmp(key, "channel")) params = strcmp(val, "pm25") ? &co_params : &pm25_params;
+            else if (!strcmp(key, "expect_alarm")) snprintf(e.expect, sizeof(e.expect), "%.7s", val);
+            else if (!strcmp(key, "onset_s")) e.onset_s = strtof(val, NULL);
+            else if (!strcmp(key, "max_latency_s")) e.max_latency_s = strtof(val, NULL);
+            else if (!strcmp(key, "max_alarm_s")) e.max_alarm_s = strtof(val, NULL);
+            continue;
+        }
+        if (!started) {
+            run_begin(&r, params);
+            started = 1;
+        }
+        run_sample(&r, strtof(line, NULL));
+    }
+    fclose(f);
+    if (!started) {
+        fprintf(stderr, "%s: no samples\n", path);
+        return 0;
+    }
+    int ok = run_check(&r, &e);
+    run_print(path, &r, ok);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int failed = 0;
+    if (argc < 2) {
+        failed = replay_synthetic();
+    } else {
+        for (int i = 1; i < argc; i++)
+            if (!replay_csv(argv[i])) failed++;
+    }
+    printf("%d failed\n", failed);
+    return failed ? 1 : 0;
+}